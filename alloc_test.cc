@@ -0,0 +1,100 @@
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+
+// Checks that once a workspace is prepared for an algorithm code, running it
+// doesn't allocate: operator new is replaced with one that counts, and every
+// algorithm code is run (cold and warm start, the fixed-size kernels and the
+// general path, and k-way) and asserted to make zero allocations.
+//
+//     make alloc_test && ./alloc_test
+
+static long allocs = 0;
+
+// gcc can't tell these frees pair with the malloc in our operator new
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new(size_t n) {
+    allocs++;
+    void *p = malloc(n);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+#define main partition_main
+#include "partition.cc"
+#undef main
+
+struct alloc_case {
+    int code;
+    heuristic run;    // NULL for KK
+};
+
+const alloc_case alloc_cases[] = {
+    {0, NULL},
+    {1, std_repeated_random},
+    {2, std_hill_climbing},
+    {3, std_simulated_annealing},
+    {4, std_hill_climbing_lanes<lane_count>},
+    {5, std_steepest_descent},
+    {11, prep_repeated_random},
+    {12, prep_hill_climbing},
+    {13, prep_simulated_annealing},
+};
+
+// runs every case on a random instance of size n, k subsets
+void check_allocs(int n, int k, bool warm_start) {
+    vector<double> input;
+    bench_family fam = {"alloc", n, 1e12};
+    bench_instance(input, fam, n * 31 + k);
+    workspace ws(n, k);
+    ws.warm_start = warm_start;
+    int n_cases = sizeof(alloc_cases) / sizeof(alloc_cases[0]);
+    for (int c = 0; c < n_cases; c++) {
+        const alloc_case &ac = alloc_cases[c];
+        // k-way only applies to KK and the prepartitioned codes
+        if (k > 2 && ac.code != 0 && ac.code < 11) {
+            continue;
+        }
+        ws.prepare(ac.code);
+        long before = allocs;
+        double res;
+        if (ac.run == NULL) {
+            if (k > 2) {
+                res = kway_kar_karp(input, ws.kk_tuples);
+            }
+            else {
+                v_to_h(input, ws.kk_heap);
+                res = kar_karp(ws.kk_heap);
+            }
+        }
+        else {
+            res = ac.run(input, ws);
+        }
+        long made = allocs - before;
+        printf("n=%d k=%d warm=%d code=%d residue=%.0f allocs=%ld\n", n, k, warm_start, ac.code, res, made);
+        assert(made == 0);
+    }
+}
+
+int main() {
+    // 100 uses the fixed-size kernels, 37 the general path
+    check_allocs(100, 2, false);
+    check_allocs(100, 2, true);
+    check_allocs(37, 2, false);
+    check_allocs(37, 2, true);
+    check_allocs(100, 3, false);
+    check_allocs(37, 5, false);
+    printf("ok\n");
+    return 0;
+}
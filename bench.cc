@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// Reproducible quality-vs-time benchmark over fixed-seed instance families:
+//
+//     ./partition bench [trials] [seed] > results.jsonl
+//
+// For every family, trial, algorithm code and start (cold = random start,
+// warm = started from the KK partition; KK itself only runs cold) it writes
+// one JSON line with the starting and final residue, the cpu time, the
+// best-so-far curve as [cpu ms, residue] pairs, and the iteration at which the
+// best residue first reached the target (-1 if never): the instance's KK
+// residue / 10 for the standard representation, KK / 100 for the
+// prepartitioned one. Both are strictly below a nonzero KK, so a warm start
+// (which begins at KK) only reaches it by improving. Then one summary line per
+// (family, algorithm, start) with residue and latency percentiles, how often
+// the run improved on its start at all, and how often / how fast the target
+// was reached. The same seed
+// gives the same instances and algorithm RNG streams, so two builds' outputs
+// can be diffed line by line.
+//
+// Families vary n, the value range (up to the graded 10^12) and hardness:
+// kappa = log2(max value) / n is the usual hardness measure for random number
+// partitioning, with instances past kappa ~ 1 being the hard ones (perfect
+// partitions stop existing), and the families straddle that line.
+
+struct bench_family {
+    const char *name;
+    int n;
+    double max_val;
+};
+
+const bench_family bench_families[] = {
+    {"n100_r1e12", 100, 1e12},    // the graded setting, kappa 0.40
+    {"n100_r1e6", 100, 1e6},      // easy, kappa 0.20
+    {"n25_r1e6", 25, 1e6},        // near the transition, kappa 0.80
+    {"n25_r1e12", 25, 1e12},      // hard, kappa 1.59
+    {"n40_r1e12", 40, 1e12},      // hard, kappa 1.00
+    {"n256_r1e12", 256, 1e12},    // large n, kappa 0.16
+};
+
+typedef double (*heuristic)(const vector<double> &, workspace &);
+
+struct bench_algorithm {
+    int code;
+    const char *name;
+    heuristic run;    // NULL for KK
+};
+
+const bench_algorithm bench_algorithms[] = {
+    {0, "kk", NULL},
+    {1, "std_rand", std_repeated_random},
+    {2, "std_hill", std_hill_climbing},
+    {3, "std_anneal", std_simulated_annealing},
+    {4, "std_hill_lanes", std_hill_climbing_lanes<lane_count>},
+    {5, "std_steepest", std_steepest_descent},
+    {11, "part_rand", prep_repeated_random},
+    {12, "part_hill", prep_hill_climbing},
+    {13, "part_anneal", prep_simulated_annealing},
+};
+
+// nearest-rank percentile of an already sorted vector
+double percentile(const vector<double> &sorted, double p) {
+    int idx = (int) ceil(p / 100.0 * sorted.size()) - 1;
+    return sorted[max(idx, 0)];
+}
+
+// instance values uniform in [1, max_val], from their own seeded stream so
+// they don't depend on how many draws the algorithms made
+void bench_instance(vector<double> &input, const bench_family &fam, uint64_t seed) {
+    xoshiro256pp gen;
+    gen.seed(seed);
+    input.resize(fam.n);
+    for (int j = 0; j < fam.n; j++) {
+        input[j] = 1 + (double) gen.below((uint64_t) fam.max_val);
+    }
+}
+
+int run_bench(int argc, char **argv) {
+    int trials = argc >= 3 ? atoi(argv[2]) : 10;
+    uint64_t seed = argc >= 4 ? strtoull(argv[3], NULL, 10) : 124;
+    assert(trials > 0);
+    int n_families = sizeof(bench_families) / sizeof(bench_families[0]);
+    int n_algorithms = sizeof(bench_algorithms) / sizeof(bench_algorithms[0]);
+
+    vector<double> input;
+    vector<double> residues;
+    vector<double> times;
+    for (int f = 0; f < n_families; f++) {
+        const bench_family &fam = bench_families[f];
+        double kappa = log2(fam.max_val) / fam.n;
+        workspace ws(fam.n);
+        ws.trace = true;
+        // every algorithm cold then warm
+        for (int v = 0; v < 2 * n_algorithms; v++) {
+            const bench_algorithm &alg = bench_algorithms[v / 2];
+            bool warm = v % 2;
+            if (warm && alg.run == NULL) {
+                continue;
+            }
+            const char *start = warm ? "warm" : "cold";
+            ws.warm_start = warm;
+            // size this algorithm's buffers now, not in its first timed run
+            ws.prepare(alg.code);
+            residues.clear();
+            times.clear();
+            int reached = 0;
+            double reached_iters = 0;
+            int improved = 0;
+            for (int t = 0; t < trials; t++) {
+                uint64_t inst_seed = seed * 1000003 + f * 1009 + t;
+                bench_instance(input, fam, inst_seed);
+                v_to_h(input, ws.kk_heap);
+                ws.target = kar_karp(ws.kk_heap) * (alg.code >= 11 ? 0.01 : 0.1);
+                ws.target_iter = -1;
+                // reseed the algorithms' RNG per run so each run is reproducible
+                moves = move_gen(inst_seed ^ 0x5bd1e995);
+                ws.curve.clear();
+                ws.trace_start = clock();
+                double res;
+                if (alg.run == NULL) {
+                    v_to_h(input, ws.kk_heap);
+                    res = kar_karp(ws.kk_heap);
+                    ws.note_best(0, res);
+                }
+                else {
+                    res = alg.run(input, ws);
+                }
+                double ms = 1000.0 * (clock() - ws.trace_start) / CLOCKS_PER_SEC;
+                residues.push_back(res);
+                times.push_back(ms);
+                // every algorithm logs its starting residue first
+                double start_res = ws.curve.front().second;
+                if (res < start_res) {
+                    improved += 1;
+                }
+                if (ws.target_iter >= 0) {
+                    reached += 1;
+                    reached_iters += ws.target_iter;
+                }
+
+                printf("{\"type\":\"run\",\"family\":\"%s\",\"n\":%d,\"max\":%.0f,\"kappa\":%.3f,"
+                       "\"algorithm\":\"%s\",\"code\":%d,\"start\":\"%s\",\"trial\":%d,\"seed\":%llu,"
+                       "\"start_residue\":%.0f,\"residue\":%.0f,\"cpu_ms\":%.3f,\"target\":%.0f,\"target_iter\":%d,\"curve\":[",
+                       fam.name, fam.n, fam.max_val, kappa, alg.name, alg.code, start, t,
+                       (unsigned long long) inst_seed, start_res, res, ms, ws.target, ws.target_iter);
+                for (int c = 0; c < (signed int) ws.curve.size(); c++) {
+                    printf("%s[%.3f,%.0f]", c ? "," : "", ws.curve[c].first, ws.curve[c].second);
+                }
+                printf("]}\n");
+            }
+            sort(residues.begin(), residues.end());
+            sort(times.begin(), times.end());
+            double mean = 0;
+            for (int t = 0; t < trials; t++) {
+                mean += residues[t] / trials;
+            }
+            printf("{\"type\":\"summary\",\"family\":\"%s\",\"n\":%d,\"max\":%.0f,\"kappa\":%.3f,"
+                   "\"algorithm\":\"%s\",\"code\":%d,\"start\":\"%s\",\"trials\":%d,"
+                   "\"residue_mean\":%.1f,\"residue_p50\":%.0f,\"residue_p90\":%.0f,"
+                   "\"cpu_ms_p50\":%.3f,\"cpu_ms_p90\":%.3f,\"cpu_ms_p99\":%.3f,\"cpu_ms_max\":%.3f,"
+                   "\"improved\":%d,\"target_reached\":%d,\"target_iter_mean\":%.1f}\n",
+                   fam.name, fam.n, fam.max_val, kappa, alg.name, alg.code, start, trials,
+                   mean, percentile(residues, 50), percentile(residues, 90),
+                   percentile(times, 50), percentile(times, 90), percentile(times, 99), times.back(),
+                   improved, reached, reached ? reached_iters / reached : -1.0);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <array>
+#include <span>
+#include <algorithm>
+#include <type_traits>
+using namespace std;
+
+// Fixed-size versions of the hot kernels. Instances are almost always exactly
+// 100 elts (and otherwise usually a power of 2), so with N known at compile
+// time the loops have constant trip counts the compiler can fully unroll and
+// vectorize. res_calc, A_prime and prep_res_calc dispatch here through
+// with_fixed_size and fall back to the dynamic code for everything else. All
+// of these are constexpr, so they can be checked with static_assert below.
+
+// calls f with n as a compile-time constant if n is one of the specialized
+// sizes and returns true, otherwise returns false without calling f
+template <typename F>
+bool with_fixed_size(size_t n, F f) {
+    switch (n) {
+        case 64:
+            f(integral_constant<size_t, 64>());
+            return true;
+        case 100:
+            f(integral_constant<size_t, 100>());
+            return true;
+        case 128:
+            f(integral_constant<size_t, 128>());
+            return true;
+        case 256:
+            f(integral_constant<size_t, 256>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <size_t N>
+constexpr double res_calc_fixed(span<const double, N> input, span<const double, N> sol) {
+    // four independent partial sums, so the reduction vectorizes w/o -ffast-math
+    // (inputs are integers < 2^53 / N, so the sum is exact in any order)
+    double part[4] = {0, 0, 0, 0};
+    for (size_t k = 0; k + 4 <= N; k += 4) {
+        for (size_t j = 0; j < 4; j++) {
+            part[j] += input[k + j] * sol[k + j];
+        }
+    }
+    double residue = (part[0] + part[1]) + (part[2] + part[3]);
+    for (size_t k = N - N % 4; k < N; k++) {
+        residue += input[k] * sol[k];
+    }
+    return residue < 0 ? -residue : residue;
+}
+
+template <size_t N>
+constexpr void A_prime_fixed(span<const double, N> input, span<const double, N> sol, span<double, N> output) {
+    for (size_t k = 0; k < N; k++) {
+        output[k] = 0;
+    }
+    for (size_t k = 0; k < N; k++) {
+        output[(size_t) sol[k]] += input[k];
+    }
+}
+
+// KK on a stack array: same max/second_max loop as kar_karp, with the heap
+// living in N doubles on the stack instead of a heap struct
+template <size_t N>
+constexpr double kar_karp_fixed(span<const double, N> input) {
+    array<double, N> h{};
+    for (size_t k = 0; k < N; k++) {
+        h[k] = input[k];
+    }
+    make_heap(h.begin(), h.end());
+    size_t size = N;
+    while (size > 1) {
+        pop_heap(h.begin(), h.begin() + size);
+        double max = h[size - 1];
+        size -= 1;
+        pop_heap(h.begin(), h.begin() + size);
+        h[size - 1] = max - h[size - 1];
+        push_heap(h.begin(), h.begin() + size);
+    }
+    return h[0];
+}
+
+// compile-time checks on small arrays
+static_assert(res_calc_fixed<4>(array<double, 4>{1, 2, 3, 5}, array<double, 4>{1, -1, -1, 1}) == 1);
+static_assert(res_calc_fixed<5>(array<double, 5>{4, 1, 1, 1, 1}, array<double, 5>{-1, 1, 1, 1, -1}) == 2);
+static_assert(kar_karp_fixed<5>(array<double, 5>{10, 8, 7, 6, 5}) == 2);
+static_assert(kar_karp_fixed<4>(array<double, 4>{3, 3, 2, 2}) == 0);
+static_assert([] {
+    array<double, 4> out{};
+    A_prime_fixed<4>(array<double, 4>{1, 2, 3, 4}, array<double, 4>{0, 3, 0, 3}, out);
+    return out[0] == 4 && out[1] == 0 && out[2] == 0 && out[3] == 6;
+}());
@@ -0,0 +1,224 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+using namespace std;
+
+// Instance generator:
+//
+//     ./partition gen <uniform|powerlaw|clustered> <n> <count> <seed> <prefix> [text|bin] [max] [alpha]
+//
+// writes count instances of n values in [1, max] (max defaults to 10^12) to
+// <prefix>_<i>.txt, one number per line, or <prefix>_<i>.bin as raw
+// little-endian uint64s (both load with ./partition, in memory or streaming).
+// powerlaw is a Pareto with exponent alpha truncated to [1, max]; the
+// default 0.1 spreads values over every magnitude up to max (median ~10^3
+// at max 10^12, 7% above 10^9), where alpha = 1 would put half of them at 1-2.
+// Every instance is cut into blocks of gen_block_size values, and each block
+// gets its own xoshiro stream seeded from (seed, instance, block), so the
+// output only depends on the arguments, not on the thread count. A pool of
+// worker threads claims blocks in order off an atomic counter and formats
+// each into one of a ring of buffers, which the main thread writes out in
+// order with one fwrite each.
+
+const long long gen_block_size = 1 << 20;
+// default power-law exponent, and cluster count / relative width for clustered
+const double gen_powerlaw_alpha = 0.1;
+const int gen_clusters = 8;
+const double gen_cluster_width = 1e-3;
+
+enum gen_dist { GEN_UNIFORM, GEN_POWERLAW, GEN_CLUSTERED };
+
+struct gen_spec {
+    gen_dist dist;
+    long long n;
+    int count;
+    uint64_t seed;
+    uint64_t max_val;
+    double alpha;
+    bool binary;
+};
+
+uint64_t gen_mix(uint64_t seed, uint64_t inst, uint64_t block) {
+    return seed ^ (inst * 0x9e3779b97f4a7c15ULL) ^ (block * 0xc2b2ae3d27d4eb4fULL);
+}
+
+// appends v in decimal plus a newline
+void gen_append_text(vector<char> &out, uint64_t v) {
+    char digits[24];
+    int d = 0;
+    do {
+        digits[d++] = '0' + v % 10;
+        v /= 10;
+    } while (v > 0);
+    while (d > 0) {
+        out.push_back(digits[--d]);
+    }
+    out.push_back('\n');
+}
+
+// generates and formats block b of instance inst into out
+void gen_block(const gen_spec &spec, int inst, long long b, vector<char> &out) {
+    out.clear();
+    xoshiro256pp gen;
+    // cluster centers are per instance, so they come from the instance's own
+    // stream (block -1) rather than this block's
+    uint64_t centers[gen_clusters];
+    if (spec.dist == GEN_CLUSTERED) {
+        gen.seed(gen_mix(spec.seed, inst, ~0ULL));
+        for (int c = 0; c < gen_clusters; c++) {
+            centers[c] = 1 + gen.below(spec.max_val);
+        }
+    }
+    gen.seed(gen_mix(spec.seed, inst, b));
+    double max_d = (double) spec.max_val;
+    uint64_t width = max((uint64_t) (gen_cluster_width * max_d), (uint64_t) 1);
+
+    long long start = b * gen_block_size;
+    long long end = min(start + gen_block_size, spec.n);
+    for (long long j = start; j < end; j++) {
+        uint64_t v;
+        if (spec.dist == GEN_UNIFORM) {
+            v = 1 + gen.below(spec.max_val);
+        }
+        else if (spec.dist == GEN_POWERLAW) {
+            // inverse CDF of a Pareto on [1, max] truncated at max
+            double u = (gen.next() >> 11) * 0x1.0p-53;
+            double x = pow(1 - u * (1 - pow(max_d, -spec.alpha)), -1 / spec.alpha);
+            v = min(max((uint64_t) llround(x), (uint64_t) 1), spec.max_val);
+        }
+        else {
+            uint64_t r = gen.next();
+            long long offset = (long long) ((r >> 8) % (2 * width + 1)) - (long long) width;
+            long long val = (long long) centers[r & (gen_clusters - 1)] + offset;
+            v = min(max(val, 1LL), (long long) spec.max_val);
+        }
+        if (spec.binary) {
+            // little-endian whatever the host is
+            for (int byte = 0; byte < 8; byte++) {
+                out.push_back((char) (v >> (8 * byte)));
+            }
+        }
+        else {
+            gen_append_text(out, v);
+        }
+    }
+}
+
+// blocks to write, the ring of buffers they're formatted into, and what the
+// workers and the writer need to hand buffers back and forth
+struct gen_pool {
+    const gen_spec &spec;
+    long long blocks_per;
+    long long items;
+    int slots;
+    vector<vector<char>> bufs;
+    vector<bool> ready;
+    // next work item to claim
+    atomic<long long> next_item;
+    // items written so far; item i may use slot i % slots once i < written + slots
+    long long written = 0;
+    mutex mu;
+    condition_variable cv;
+
+    gen_pool(const gen_spec &spec_, long long blocks_per_, int slots_)
+        : spec(spec_), blocks_per(blocks_per_), items(blocks_per_ * spec_.count),
+          slots(slots_), bufs(slots_), ready(slots_, false), next_item(0) {}
+};
+
+void gen_worker(gen_pool &pool) {
+    while (true) {
+        long long item = pool.next_item.fetch_add(1);
+        if (item >= pool.items) {
+            return;
+        }
+        int slot = item % pool.slots;
+        {
+            unique_lock<mutex> lock(pool.mu);
+            pool.cv.wait(lock, [&] { return item < pool.written + pool.slots; });
+        }
+        gen_block(pool.spec, item / pool.blocks_per, item % pool.blocks_per, pool.bufs[slot]);
+        {
+            lock_guard<mutex> lock(pool.mu);
+            pool.ready[slot] = true;
+        }
+        pool.cv.notify_all();
+    }
+}
+
+int run_gen(int argc, char **argv) {
+    if (argc < 7) {
+        fprintf(stderr, "usage: %s gen <uniform|powerlaw|clustered> <n> <count> <seed> <prefix> [text|bin] [max] [alpha]\n", argv[0]);
+        return 1;
+    }
+    gen_spec spec;
+    string dist = argv[2];
+    if (dist == "uniform") {
+        spec.dist = GEN_UNIFORM;
+    }
+    else if (dist == "powerlaw") {
+        spec.dist = GEN_POWERLAW;
+    }
+    else if (dist == "clustered") {
+        spec.dist = GEN_CLUSTERED;
+    }
+    else {
+        fprintf(stderr, "unknown distribution %s\n", argv[2]);
+        return 1;
+    }
+    spec.n = atoll(argv[3]);
+    spec.count = atoi(argv[4]);
+    spec.seed = strtoull(argv[5], NULL, 10);
+    string prefix = argv[6];
+    spec.binary = argc >= 8 && string(argv[7]) == "bin";
+    spec.max_val = argc >= 9 ? strtoull(argv[8], NULL, 10) : 1000000000000ULL;
+    spec.alpha = argc >= 10 ? atof(argv[9]) : gen_powerlaw_alpha;
+    assert(spec.n > 0 && spec.count > 0 && spec.max_val > 0 && spec.alpha > 0);
+
+    // flatten (instance, block) into one ordered list of work items
+    long long blocks_per = (spec.n + gen_block_size - 1) / gen_block_size;
+    int threads = max((int) thread::hardware_concurrency(), 1);
+    // two buffers per thread, so workers keep going while one is written
+    gen_pool pool(spec, blocks_per, 2 * threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(gen_worker, ref(pool));
+    }
+
+    // write every item in order, opening/closing files at instance edges
+    FILE *out = NULL;
+    for (long long item = 0; item < pool.items; item++) {
+        int slot = item % pool.slots;
+        {
+            unique_lock<mutex> lock(pool.mu);
+            pool.cv.wait(lock, [&] { return (bool) pool.ready[slot]; });
+        }
+        if (item % blocks_per == 0) {
+            string name = prefix + "_" + to_string(item / blocks_per) + (spec.binary ? ".bin" : ".txt");
+            out = fopen(name.c_str(), "wb");
+            assert(out != NULL);
+        }
+        fwrite(pool.bufs[slot].data(), 1, pool.bufs[slot].size(), out);
+        if (item % blocks_per == blocks_per - 1) {
+            fclose(out);
+            out = NULL;
+        }
+        {
+            lock_guard<mutex> lock(pool.mu);
+            pool.ready[slot] = false;
+            pool.written += 1;
+        }
+        pool.cv.notify_all();
+    }
+    for (int t = 0; t < threads; t++) {
+        workers[t].join();
+    }
+    return 0;
+}
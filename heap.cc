@@ -13,6 +13,16 @@ struct heap {
         return h.size();
     }
 
+    // reserve room for n elts up front so insert never reallocates
+    void reserve(int n) {
+        h.reserve(n);
+    }
+
+    // empty the heap but keep its storage around for reuse
+    void clear() {
+        h.clear();
+    }
+
     // sorts a subtree tree with root, used post-insert and post-pop
     void heapify(int root) {
         int size = h.size();
@@ -71,13 +81,13 @@ struct heap {
     }
 };
 
-// function to quickly convert vectors to heaps for kar_karp calls
-heap v_to_h(vector<double> v) {
-    heap h;
+// function to quickly convert vectors to heaps for kar_karp calls - fills
+// the caller's heap in place so its storage gets reused between calls
+void v_to_h(const vector<double> &v, heap &h) {
+    h.clear();
     for (int i = 0; i < (signed int) v.size(); i++) {
         h.insert(v[i]);
     }
-    return h;
 }
 
 // // printing helpers
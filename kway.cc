@@ -0,0 +1,191 @@
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <assert.h>
+using namespace std;
+
+// k-way Karmarkar-Karp: every element starts as the k-tuple (a, 0, ..., 0).
+// We repeatedly pop the two tuples with the largest spread, merge them by
+// pairing the largest entry of one with the smallest of the other, re-sort
+// and subtract the min, then push the result back. The residue at the end is
+// max - min of the last tuple, which after normalizing is just its max.
+
+struct tuple_heap {
+    int k = 2;
+    // heap entries kept structure-of-arrays: sifting only walks these two
+    // compact arrays and never touches the (up to 64-wide) tuples themselves
+    vector<double> key;   // spread (max - min) of each tuple, max-heap ordered
+    vector<int> slot;     // pool slot holding the tuple, -1 for a singleton (key, 0, ..., 0)
+    // tuples that have been merged at least once live here, k doubles per
+    // slot, sorted descending and normalized so the last entry is 0
+    vector<double> pool;
+    vector<int> free_slots;
+    vector<double> scratch;
+
+    int size() {
+        return key.size();
+    }
+
+    // sizes every buffer for an n-elt, k-way run so nothing reallocates - a
+    // merged tuple eats two entries, so at most n/2 of them are ever alive
+    void reserve(int n, int k_) {
+        k = k_;
+        key.reserve(n);
+        slot.reserve(n);
+        pool.reserve((n / 2 + 1) * k);
+        free_slots.reserve(n / 2 + 1);
+        scratch.resize(2 * k);
+    }
+
+    void clear() {
+        key.clear();
+        slot.clear();
+        pool.clear();
+        free_slots.clear();
+    }
+
+    double *tuple(int s) {
+        return &pool[s * k];
+    }
+
+    int new_slot() {
+        if (!free_slots.empty()) {
+            int s = free_slots.back();
+            free_slots.pop_back();
+            return s;
+        }
+        pool.resize(pool.size() + k);
+        return pool.size() / k - 1;
+    }
+
+    void sift_up(int curr) {
+        double kv = key[curr];
+        int sv = slot[curr];
+        while (curr > 0) {
+            int parent = (curr - 1) / 2;
+            if (key[parent] >= kv) {
+                break;
+            }
+            key[curr] = key[parent];
+            slot[curr] = slot[parent];
+            curr = parent;
+        }
+        key[curr] = kv;
+        slot[curr] = sv;
+    }
+
+    void sift_down(int curr) {
+        int size = key.size();
+        double kv = key[curr];
+        int sv = slot[curr];
+        while (true) {
+            int child = 2 * curr + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && key[child + 1] > key[child]) {
+                child += 1;
+            }
+            if (key[child] <= kv) {
+                break;
+            }
+            key[curr] = key[child];
+            slot[curr] = slot[child];
+            curr = child;
+        }
+        key[curr] = kv;
+        slot[curr] = sv;
+    }
+
+    // load singletons in one go and heapify bottom-up, O(n) instead of n inserts
+    void build(const vector<double> &v) {
+        clear();
+        scratch.resize(2 * k);
+        for (int i = 0; i < (signed int) v.size(); i++) {
+            key.push_back(v[i]);
+            slot.push_back(-1);
+        }
+        for (int i = (signed int) key.size() / 2 - 1; i >= 0; i--) {
+            sift_down(i);
+        }
+    }
+
+    void insert(double kv, int sv) {
+        key.push_back(kv);
+        slot.push_back(sv);
+        sift_up(key.size() - 1);
+    }
+
+    void pop(double &kv, int &sv) {
+        assert(key.size() > 0);
+        kv = key[0];
+        sv = slot[0];
+        key[0] = key.back();
+        slot[0] = slot.back();
+        key.pop_back();
+        slot.pop_back();
+        if (key.size() > 0) {
+            sift_down(0);
+        }
+    }
+
+    // writes the (sorted, normalized) tuple of an entry into out
+    void expand(double kv, int sv, double *out) {
+        if (sv < 0) {
+            out[0] = kv;
+            fill(out + 1, out + k, 0.0);
+        }
+        else {
+            copy(tuple(sv), tuple(sv) + k, out);
+        }
+    }
+
+    // merges two tuples largest-with-smallest and pushes the result
+    void merge(double ka, int sa, double kb, int sb) {
+        double *a = &scratch[0];
+        double *b = &scratch[k];
+        expand(ka, sa, a);
+        expand(kb, sb, b);
+        // reuse one of the inputs' slots for the result, free the other
+        int out_slot;
+        if (sa >= 0) {
+            out_slot = sa;
+            if (sb >= 0) {
+                free_slots.push_back(sb);
+            }
+        }
+        else if (sb >= 0) {
+            out_slot = sb;
+        }
+        else {
+            out_slot = new_slot();
+        }
+        double *out = tuple(out_slot);
+        for (int i = 0; i < k; i++) {
+            out[i] = a[i] + b[k - 1 - i];
+        }
+        sort(out, out + k, greater<double>());
+        double min = out[k - 1];
+        for (int i = 0; i < k; i++) {
+            out[i] -= min;
+        }
+        insert(out[0], out_slot);
+    }
+};
+
+// k-way KK on input, using th as scratch; returns max - min subset sum
+double kway_kar_karp(const vector<double> &input, tuple_heap &th) {
+    if (input.size() == 0) {
+        return 0;
+    }
+    th.build(input);
+    while (th.size() > 1) {
+        double ka, kb;
+        int sa, sb;
+        th.pop(ka, sa);
+        th.pop(kb, sb);
+        th.merge(ka, sa, kb, sb);
+    }
+    // last tuple is normalized, so its spread is its largest entry
+    return th.key[0];
+}
@@ -9,32 +9,192 @@
 #include <cstdarg>
 #include <cassert>
 #include <string>
+#include <ctime>
 #include "heap.cc"
+#include "kway.cc"
+#include "stream.cc"
+#include "fixed.cc"
+#include "rng.cc"
 
 using namespace std;
 
 
 random_device dev; //Will be used to obtain a seed for the random number engine
-mt19937 mersenne(dev()); //Standard mersenne_twister_engine seeded with dev()
 
-//Initialize random number generator for matrix values between 0 and 1
-uniform_int_distribution<> value_gen(0,1);
+//Random solutions, neighbor moves and annealing coin flips all come from here
+move_gen moves(((uint64_t) dev() << 32) | dev());
 
-//Initialize random int generator to choose which sign we switch for hill_climbing
-uniform_int_distribution<> switch_gen(0,99);
 
-//Initialize random real number generator to determine how to move for annealing
-uniform_real_distribution<> annealing_gen(0.0,1.0);
+// neighbor moves for the prepartitioned heuristics are scored a block of
+// prep_batch_size at a time (see prep_eval_batch)
+const int prep_batch_size = 8;
 
-//Initialize random int generator to choose which sign we switch for hill_climbing
-uniform_int_distribution<> part_idx_gen(0,99);
+// past this many nonzero A' sums, the block's KK runs on heaps instead of
+// the sorted slide (see kar_karp_sorted_heap)
+const int prep_slide_max_len = 288;
 
+// chains run side by side by the lockstep hill climber (algorithm 4)
+const int lane_count = 16;
 
-// Karmarker-Karp algorithm using heap: heap will update in the 
-// following manner: delete max and second_max, insert 
+// one proposed move: idx_1 to class_1, and idx_2 to class_2 if idx_2 >= 0,
+// plus the (up to 4) classes it changes with their sums before and after
+struct prep_move {
+    int idx_1, class_1, idx_2, class_2;
+    int changes;
+    int cls[4];
+    double old_sum[4];
+    double new_sum[4];
+
+    void add(int c, double delta, const vector<double> &S_prime) {
+        for (int j = 0; j < changes; j++) {
+            if (cls[j] == c) {
+                new_sum[j] += delta;
+                return;
+            }
+        }
+        cls[changes] = c;
+        old_sum[changes] = S_prime[c];
+        new_sum[changes] = S_prime[c] + delta;
+        changes++;
+    }
+};
+
+// workspace owning every buffer the heuristics touch: built once per solve
+// and handed to each algorithm, so the 25000-iteration loops never allocate.
+// Only the sign vectors are sized up front; each algorithm sizes the rest of
+// what it uses with an ensure_* call before its loop (a no-op once sized)
+
+struct workspace {
+    // current/best solution, candidate neighbor, and best-ever (S'' for annealing)
+    vector<double> sol;
+    vector<double> neighbor;
+    vector<double> best_sol;
+    // A' buffers for the prepartitioned representation
+    vector<double> sol_prime;
+    vector<double> neighbor_prime;
+    // heap reused by every kar_karp call
+    heap kk_heap;
+    // number of subsets, and the tuple heap reused by kway_kar_karp when k > 2
+    int k;
+    tuple_heap kk_tuples;
+    // [idx][lane] signs for the lockstep multi-chain hill climber
+    vector<double> lane_signs;
+    // idxs on each side of the partition, sorted by value, for steepest descent
+    vector<int> plus_idx;
+    vector<int> minus_idx;
+    // batched prepartition evaluation: S's nonzero A' sorted descending, and
+    // per block the moves, their sorted A' rows (one per move), and residues
+    vector<double> sorted_prime;
+    prep_move batch_moves[prep_batch_size];
+    vector<double> batch_rows;
+    int batch_len[prep_batch_size];
+    double batch_res[prep_batch_size];
+    // warm start: seed heuristics from the KK partition instead of a random
+    // one; kk_nodes/kk_edges are scratch for recovering that partition
+    bool warm_start = false;
+    vector<pair<double, int>> kk_nodes;
+    vector<pair<int, int>> kk_edges;
+    // iteration at which the best residue first got to <= target (-1 until
+    // it does, 0 if the starting solution already does) - for measuring
+    double target = -1;
+    int target_iter = -1;
+    // when tracing, every best-so-far improvement is logged as (cpu ms since
+    // trace_start, residue) - used by the bench driver for quality-vs-time curves
+    bool trace = false;
+    clock_t trace_start = 0;
+    vector<pair<double, double>> curve;
+
+    // input length every buffer is sized for
+    int size;
+
+    workspace(int size_, int k_ = 2) {
+        size = size_;
+        k = k_;
+        sol.resize(size);
+        neighbor.resize(size);
+        best_sol.resize(size);
+    }
+
+    // the KK heap, or the tuple heap when k > 2
+    void ensure_kk() {
+        if (k > 2) {
+            kk_tuples.reserve(size, k);
+        }
+        else {
+            kk_heap.reserve(size);
+        }
+    }
+
+    // A' buffers plus the heap prep_res_calc runs KK on
+    void ensure_prep() {
+        sol_prime.resize(size);
+        neighbor_prime.resize(size);
+        ensure_kk();
+    }
+
+    // S's sorted A' and the block's neighbor rows, for prep_eval_batch
+    void ensure_batch() {
+        sorted_prime.resize(size);
+        batch_rows.resize(size * prep_batch_size);
+    }
+
+    // scratch for recovering the KK partition to warm start from
+    void ensure_warm() {
+        kk_nodes.reserve(size);
+        kk_edges.reserve(size);
+    }
+
+    // [idx][lane] signs for a climber running lanes chains
+    void ensure_lanes(int lanes) {
+        if ((signed int) lane_signs.size() < size * lanes) {
+            lane_signs.resize(size * lanes);
+        }
+    }
+
+    void ensure_steepest() {
+        plus_idx.reserve(size);
+        minus_idx.reserve(size);
+    }
+
+    // everything algorithm code needs, so a later call to it doesn't allocate
+    void prepare(int algorithm) {
+        if (algorithm == 0 || algorithm >= 11) {
+            ensure_kk();
+        }
+        if (algorithm >= 11) {
+            ensure_prep();
+        }
+        if ((algorithm == 12 || algorithm == 13) && k == 2) {
+            ensure_batch();
+        }
+        if (algorithm == 4) {
+            ensure_lanes(lane_count);
+        }
+        if (algorithm == 5) {
+            ensure_steepest();
+        }
+        if (warm_start) {
+            ensure_warm();
+        }
+    }
+
+    // call whenever the best residue improves, at iteration i
+    void note_best(int i, double res) {
+        if (target_iter < 0 && res <= target) {
+            target_iter = i;
+        }
+        if (trace) {
+            curve.push_back({1000.0 * (clock() - trace_start) / CLOCKS_PER_SEC, res});
+        }
+    }
+};
+
+// Karmarker-Karp algorithm using heap: heap will update in the
+// following manner: delete max and second_max, insert
 // |max - second_max|, repeat until only 1 element left
+// (consumes the heap it is given)
 
-double kar_karp(heap input) {
+double kar_karp(heap &input) {
     while (input.size() > 1) {
         double max = input.pop();
         double second_max = input.pop();
@@ -43,10 +203,55 @@ double kar_karp(heap input) {
     return input.h[0];
 }
 
+// KK that also recovers the partition: each step records an edge between the
+// max and second_max elts (they land on opposite sides), and the difference
+// carries on as the max elt. Walking the edges backwards from the last
+// survivor then assigns every elt a sign. Writes +/-1 into signs.
+
+void kar_karp_signs(const vector<double> &input, vector<double> &signs, workspace &ws) {
+    int s = input.size();
+    if (s == 0) {
+        return;
+    }
+    ws.ensure_warm();
+    vector<pair<double, int>> &nodes = ws.kk_nodes;
+    vector<pair<int, int>> &edges = ws.kk_edges;
+    nodes.clear();
+    edges.clear();
+    for (int j = 0; j < s; j++) {
+        nodes.push_back({input[j], j});
+    }
+    make_heap(nodes.begin(), nodes.end());
+    while (nodes.size() > 1) {
+        pop_heap(nodes.begin(), nodes.end());
+        pair<double, int> max = nodes.back();
+        nodes.pop_back();
+        pop_heap(nodes.begin(), nodes.end());
+        pair<double, int> second_max = nodes.back();
+        nodes.pop_back();
+        edges.push_back({max.second, second_max.second});
+        nodes.push_back({max.first - second_max.first, max.second});
+        push_heap(nodes.begin(), nodes.end());
+    }
+    // a later edge only ever involves elts still alive, so going backwards the
+    // first endpoint's sign is always known by the time we reach its edge
+    signs[nodes[0].second] = 1;
+    for (int e = edges.size() - 1; e >= 0; e--) {
+        signs[edges[e].second] = -signs[edges[e].first];
+    }
+}
+
 // residue calculator
 
-double res_calc(vector<double> input, vector<double> sol) {
+double res_calc(const vector<double> &input, const vector<double> &sol) {
     double residue = 0;
+    // common sizes go to the unrolled fixed-size kernel
+    if (with_fixed_size(input.size(), [&](auto n) {
+            residue = res_calc_fixed<n>(span<const double, n>(input.data(), n),
+                                        span<const double, n>(sol.data(), n));
+        })) {
+        return residue;
+    }
     for(int k = 0; k < (signed int) input.size(); k++) {
         residue += input[k]*sol[k];
     }
@@ -56,374 +261,1009 @@ double res_calc(vector<double> input, vector<double> sol) {
     return residue;
 }
 
-// rand sol generator
+// rand sol generator - overwrites sol in place
 
-vector<double> rand_sol_standard(int size) {
-    vector<double> signs = {-1, 1};
-    vector<double> sol;
-    for (int j = 0; (signed int) j < size; j++){
-        sol.push_back(signs[value_gen(mersenne)]);
+void rand_sol_standard(vector<double> &sol) {
+    static const double signs[2] = {-1, 1};
+    for (int j = 0; j < (signed int) sol.size(); j++){
+        sol[j] = signs[moves.coin()];
+    }
+}
+
+// starting point for the standard heuristics: KK's signs on warm start,
+// otherwise uniformly random
+
+void init_sol_standard(const vector<double> &input, vector<double> &sol, workspace &ws) {
+    if (ws.warm_start) {
+        kar_karp_signs(input, sol, ws);
+    }
+    else {
+        rand_sol_standard(sol);
     }
-    return sol;
 }
 
 //The three following functions are implementations of the NP-heuristics detailed
 //in the programming assignment specifications for the standard representation
 
-double std_repeated_random(vector<double> A_input) {
+double std_repeated_random(const vector<double> &A_input, workspace &ws) {
     //Generate initial random solution w/ residue; for loop will potentially update
-    int s = A_input.size();
-    vector<double> opt_sol = rand_sol_standard(s);
-    double opt_residue = res_calc(A_input, opt_sol);
+    init_sol_standard(A_input, ws.sol, ws);
+    double opt_residue = res_calc(A_input, ws.sol);
+    ws.note_best(0, opt_residue);
 
     for (int i = 0; i < 25000; i++) {
         // generate random sol and its residue
-        vector<double> potential_sol = rand_sol_standard(s);
-        double potential_residue = res_calc(A_input, potential_sol);
-        //Assign sign sequence w/ better residue to main solution
+        rand_sol_standard(ws.neighbor);
+        double potential_residue = res_calc(A_input, ws.neighbor);
+        //Assign sign sequence w/ better residue to main solution - swap
+        //buffers rather than copy, old opt just becomes next scratch space
         if (potential_residue < opt_residue) {
-            opt_sol = potential_sol;
+            ws.sol.swap(ws.neighbor);
             opt_residue = potential_residue;
+            ws.note_best(i + 1, opt_residue);
         }
     }
-    // return opt_sol;
+    // return ws.sol;
     return opt_residue;
 }
 
-double std_hill_climbing(vector<double> A_input) {
+double std_hill_climbing(const vector<double> &A_input, workspace &ws) {
     //Generate initial random solution w/ residue; for loop will potentially update
     int s = A_input.size();
-    vector<double> opt_sol = rand_sol_standard(s);
+    vector<double> &opt_sol = ws.sol;
+    vector<double> &neighbor = ws.neighbor;
+    init_sol_standard(A_input, opt_sol, ws);
     double opt_residue = res_calc(A_input, opt_sol);
-    vector<double> neighbor = opt_sol;
+    ws.note_best(0, opt_residue);
+    neighbor = opt_sol;
     double neighbor_res;
 
     for (int i = 0; i < 25000; i++) {
         //Calculate new neighbor of current opt_sol
-        int idx_1 = switch_gen(mersenne);
-        neighbor[idx_1] *= -1;
         // with prob 1/2, we also flip a second, distinct idx
-        int prob = value_gen(mersenne);
-        if (prob == 0) {
-            while (true) {
-                int idx_2 = switch_gen(mersenne);
-                if (idx_2 != idx_1) {
-                    neighbor[idx_2] *= -1;
-                    break;
-                }
-            }
+        int idx_1, idx_2;
+        moves.pick_idxs(s, idx_1, idx_2);
+        neighbor[idx_1] *= -1;
+        if (idx_2 >= 0) {
+            neighbor[idx_2] *= -1;
         }
         neighbor_res = res_calc(A_input, neighbor);
-        //Assign sign sequence w/ better residue to main solution
+        //Assign sign sequence w/ better residue to main solution - only the
+        //flipped idxs differ, so apply them to opt_sol instead of copying
         if (neighbor_res < opt_residue) {
-            opt_sol = neighbor;
+            opt_sol[idx_1] = neighbor[idx_1];
+            if (idx_2 >= 0) {
+                opt_sol[idx_2] = neighbor[idx_2];
+            }
             opt_residue = neighbor_res;
+            ws.note_best(i + 1, opt_residue);
         }
         // always reset neighbor so we're finding neighbors of curr_opt
-        neighbor = opt_sol;
+        else {
+            neighbor[idx_1] = opt_sol[idx_1];
+            if (idx_2 >= 0) {
+                neighbor[idx_2] = opt_sol[idx_2];
+            }
+        }
     }
     // return opt_sol;
     return opt_residue;
 }
 
-double std_simulated_annealing(vector<double> A_input) {
+double std_simulated_annealing(const vector<double> &A_input, workspace &ws) {
     //Generate initial random solution w/ residue; for loop will potentially update
-    int si = A_input.size();
-    vector<double> S_double_prime = rand_sol_standard(si);
+    int s = A_input.size();
+    vector<double> &S_double_prime = ws.best_sol;
+    vector<double> &S = ws.sol;
+    vector<double> &neighbor = ws.neighbor;
+    init_sol_standard(A_input, S_double_prime, ws);
     double S_double_residue = res_calc(A_input, S_double_prime);
-    vector<double> S = S_double_prime;
+    ws.note_best(0, S_double_residue);
+    S = S_double_prime;
     double S_res = res_calc(A_input, S);
-    vector<double> neighbor = S;
+    neighbor = S;
     double neighbor_res;
 
     for (int i = 0; i < 25000; i++) {
         //Calculate new neighbor of current opt_sol
-        int idx_1 = switch_gen(mersenne);
-        neighbor[idx_1] *= -1;
         // with prob 1/2, we also flip a second, distinct idx
-        int prob = value_gen(mersenne);
-        if (prob == 0) {
-            while (true) {
-                int idx_2 = switch_gen(mersenne);
-                if (idx_2 != idx_1) {
-                    neighbor[idx_2] *= -1;
-                    break;
-                }
-            }
+        int idx_1, idx_2;
+        moves.pick_idxs(s, idx_1, idx_2);
+        neighbor[idx_1] *= -1;
+        if (idx_2 >= 0) {
+            neighbor[idx_2] *= -1;
         }
         neighbor_res = res_calc(A_input, neighbor);
 
-        float random_annealing = annealing_gen(mersenne);
+        double random_annealing = moves.uniform();
 
         // if neighbor better then curr or certain prob for worse, we update S
         if (neighbor_res < S_res || random_annealing <= exp(-((neighbor_res - S_res)/(pow(10,10) * pow(0.8,(i/300)))))) {
-            S = neighbor;
+            S[idx_1] = neighbor[idx_1];
+            if (idx_2 >= 0) {
+                S[idx_2] = neighbor[idx_2];
+            }
             S_res = neighbor_res;
         }
+        // otherwise undo the flips, so on next iter we look for neighbors of current S
+        else {
+            neighbor[idx_1] = S[idx_1];
+            if (idx_2 >= 0) {
+                neighbor[idx_2] = S[idx_2];
+            }
+        }
 
-        // regardless of above, we check if S'' should be updated
+        // regardless of above, we check if S'' should be updated (same size,
+        // so the assignment reuses its storage)
         if (S_res < S_double_residue) {
             S_double_prime = S;
             S_double_residue = S_res;
+            ws.note_best(i + 1, S_double_residue);
         }
-        // always reset neighbor to S, so on next iter we look for neighbors of current S
-        neighbor = S;
     }
     // return S_double_prime;
     return S_double_residue;
 }
 
+// Lockstep multi-chain hill climbing: L independent standard-representation
+// chains advance together, one lane each. Per-chain state (xoshiro words,
+// signed sum D, proposed sums, accept mask) lives in L-wide arrays, and each
+// step is split so the pure per-lane arithmetic - the RNG step and the
+// accept/select - sits in its own loops, which GCC vectorizes at -O3; cutting
+// the output into idxs, reading the chosen signs/values and writing the
+// accepted flips back are gathers/scatters and stay per lane. Signs are
+// stored [idx][lane]. Flips are scored from D directly: flipping idx changes
+// D by -2 * sign * A[idx], so a step is O(1) per lane instead of res_calc's
+// O(n). Returns the best lane's residue.
+//
+// Idxs use a single Lemire multiply without the rejection step - the bias is
+// at most n / 2^31, which doesn't matter for picking neighbors.
+
+template <int L>
+double std_hill_climbing_lanes(const vector<double> &A_input, workspace &ws) {
+    int s = A_input.size();
+    ws.ensure_lanes(L);
+    vector<double> &signs = ws.lane_signs;
+
+    // per-lane RNG streams, seeded off the shared generator
+    xoshiro256pp_lanes<L> rng;
+    rng.seed(moves.rng);
+
+    // starting solutions (KK's on warm start, so all lanes start there) and
+    // their signed sums
+    double D[L];
+    for (int c = 0; c < L; c++) {
+        init_sol_standard(A_input, ws.sol, ws);
+        D[c] = 0;
+        for (int j = 0; j < s; j++) {
+            signs[(size_t) j * L + c] = ws.sol[j];
+            D[c] += A_input[j] * ws.sol[j];
+        }
+    }
+    double best = fabs(D[0]);
+    for (int c = 1; c < L; c++) {
+        best = min(best, fabs(D[c]));
+    }
+    ws.note_best(0, best);
+    if (s < 2) {
+        return best;
+    }
+
+    uint64_t r[L];
+    int idx_1[L], idx_2[L];
+    double d_1[L], d_2[L], flip_2[L], flip_1s[L], flip_2s[L];
+    for (int i = 0; i < 25000; i++) {
+        rng.next(r);
+
+        // per lane, cut the output into idx_1 (low 32 bits), an offset for a
+        // distinct idx_2 (next 31) and the coin (top bit) - idx_2 is always
+        // valid, the coin just says whether it gets flipped - and gather
+        // sign * value at both idxs
+        for (int c = 0; c < L; c++) {
+            int a = ((r[c] & 0xffffffffULL) * s) >> 32;
+            int b = (((r[c] >> 32) & 0x7fffffffULL) * (s - 1)) >> 31;
+            int a2 = a + 1 + b;
+            idx_1[c] = a;
+            idx_2[c] = a2 >= s ? a2 - s : a2;
+            flip_2[c] = (double) (r[c] >> 63);
+            d_1[c] = signs[(size_t) idx_1[c] * L + c] * A_input[idx_1[c]];
+            d_2[c] = signs[(size_t) idx_2[c] * L + c] * A_input[idx_2[c]];
+        }
+        // proposed sums, and accept wherever the residue improves (accept is
+        // 1.0/0.0 rather than a bool so the loop stays branch-free)
+        for (int c = 0; c < L; c++) {
+            double D_new = D[c] - 2 * (d_1[c] + flip_2[c] * d_2[c]);
+            double accept = fabs(D_new) < fabs(D[c]) ? 1.0 : 0.0;
+            D[c] = accept != 0 ? D_new : D[c];
+            flip_1s[c] = 1 - 2 * accept;
+            flip_2s[c] = 1 - 2 * accept * flip_2[c];
+        }
+        // scatter the flips - written unconditionally so there's no branch
+        // on the accept mask (idx_1 != idx_2, so the order doesn't matter)
+        double step_best = best;
+        for (int c = 0; c < L; c++) {
+            signs[(size_t) idx_2[c] * L + c] *= flip_2s[c];
+            signs[(size_t) idx_1[c] * L + c] *= flip_1s[c];
+            step_best = min(step_best, fabs(D[c]));
+        }
+        if (step_best < best) {
+            best = step_best;
+            ws.note_best(i + 1, best);
+        }
+    }
+    // return signs of the best lane;
+    return best;
+}
+
+// Steepest-descent local search on the standard representation. With D the
+// signed sum, flipping x off the bigger side gives |D - 2x| and swapping x
+// (bigger side) with y (smaller side) gives |D - 2(x - y)|, so the best moves
+// are the x closest to D/2 and the pair whose difference is closest to D/2.
+// Keeping each side's idxs sorted by value finds the best flip by binary
+// search and the best swap with one two-pointer sweep, and each move just
+// moves one or two idxs between the sorted lists. Takes the best move until
+// none improves (a local optimum, usually within a few moves), then restarts
+// from a random solution until the 25000-iteration budget is spent.
+
+// sorted position of idx's value within side, for inserting/erasing
+int side_pos(const vector<double> &A_input, const vector<int> &side, int idx) {
+    return lower_bound(side.begin(), side.end(), idx,
+                       [&](int a, int b) { return A_input[a] < A_input[b]; }) - side.begin();
+}
+
+void side_erase(const vector<double> &A_input, vector<int> &side, int idx) {
+    int pos = side_pos(A_input, side, idx);
+    // equal values sit together, so walk to the exact idx
+    while (side[pos] != idx) {
+        pos++;
+    }
+    side.erase(side.begin() + pos);
+}
+
+void side_insert(const vector<double> &A_input, vector<int> &side, int idx) {
+    side.insert(side.begin() + side_pos(A_input, side, idx), idx);
+}
+
+// one descent from sol (signs, updated in place), spending at most budget
+// moves; returns the residue it ends at and the moves used in moves_used
+double steepest_descent(const vector<double> &A_input, vector<double> &sol, workspace &ws,
+                        int budget, int &moves_used) {
+    int s = A_input.size();
+    vector<int> &plus = ws.plus_idx;
+    vector<int> &minus = ws.minus_idx;
+    plus.clear();
+    minus.clear();
+    double D = 0;
+    for (int j = 0; j < s; j++) {
+        (sol[j] > 0 ? plus : minus).push_back(j);
+        D += A_input[j] * sol[j];
+    }
+    auto by_value = [&](int a, int b) { return A_input[a] < A_input[b]; };
+    sort(plus.begin(), plus.end(), by_value);
+    sort(minus.begin(), minus.end(), by_value);
+
+    moves_used = 0;
+    while (moves_used < budget && D != 0) {
+        // big is the side with the larger sum; target is half the gap
+        bool plus_big = D > 0;
+        vector<int> &big = plus_big ? plus : minus;
+        vector<int> &small = plus_big ? minus : plus;
+        double gap = fabs(D);
+        double target = gap / 2;
+        double best_res = gap;
+        int best_x = -1;
+        int best_y = -1;
+
+        // best single flip: the big-side value closest to target
+        int pos = lower_bound(big.begin(), big.end(), target,
+                              [&](int a, double v) { return A_input[a] < v; }) - big.begin();
+        for (int p = max(pos - 1, 0); p <= pos && p < (signed int) big.size(); p++) {
+            double res = fabs(gap - 2 * A_input[big[p]]);
+            if (res < best_res) {
+                best_res = res;
+                best_x = big[p];
+                best_y = -1;
+            }
+        }
+
+        // best swap: x - y closest to target; as x grows the best y does too
+        int q = 0;
+        for (int p = 0; p < (signed int) big.size() && !small.empty(); p++) {
+            double want = A_input[big[p]] - target;
+            while (q + 1 < (signed int) small.size() && A_input[small[q + 1]] <= want) {
+                q++;
+            }
+            for (int r = q; r <= q + 1 && r < (signed int) small.size(); r++) {
+                double res = fabs(gap - 2 * (A_input[big[p]] - A_input[small[r]]));
+                if (res < best_res) {
+                    best_res = res;
+                    best_x = big[p];
+                    best_y = small[r];
+                }
+            }
+        }
+
+        if (best_x < 0) {
+            break;
+        }
+        // apply the move to sol, D and the sorted sides
+        side_erase(A_input, big, best_x);
+        side_insert(A_input, small, best_x);
+        sol[best_x] *= -1;
+        D -= 2 * A_input[best_x] * (plus_big ? 1 : -1);
+        if (best_y >= 0) {
+            side_erase(A_input, small, best_y);
+            side_insert(A_input, big, best_y);
+            sol[best_y] *= -1;
+            D += 2 * A_input[best_y] * (plus_big ? 1 : -1);
+        }
+        moves_used++;
+    }
+    return fabs(D);
+}
+
+double std_steepest_descent(const vector<double> &A_input, workspace &ws) {
+    ws.ensure_steepest();
+    // the 25000 budget counts moves, plus log2(n) per (re)start for its sorts,
+    // so restarts can't be free. That's an iteration count like the other
+    // heuristics', not equal work: measured, a move costs ~8-28 res_calcs (the
+    // sweep and sorted-list updates) and a restart ~35-110, so a run takes
+    // ~5-12x std_hill_climbing's time (21.6 vs 1.8 ms at n = 100, 174 vs 22
+    // ms at n = 1000)
+    int restart_cost = max((int) ceil(log2(max((int) A_input.size(), 2))), 1);
+    // first descent from the usual start (KK's signs on warm start)
+    init_sol_standard(A_input, ws.sol, ws);
+    ws.note_best(0, res_calc(A_input, ws.sol));
+    int used;
+    double opt_residue = steepest_descent(A_input, ws.sol, ws, 25000, used);
+    int spent = used + restart_cost;
+    ws.note_best(spent, opt_residue);
+
+    // then random restarts with whatever budget is left
+    while (spent < 25000 && opt_residue > 0) {
+        rand_sol_standard(ws.neighbor);
+        double res = steepest_descent(A_input, ws.neighbor, ws, 25000 - spent, used);
+        spent += used + restart_cost;
+        if (res < opt_residue) {
+            ws.sol.swap(ws.neighbor);
+            opt_residue = res;
+            ws.note_best(spent, opt_residue);
+        }
+    }
+    // return ws.sol;
+    return opt_residue;
+}
+
 //The next three functions are implementations of the NP-heuristics detailed
 //in the programming assignment specifications for the prepartitioned representation
 
-// rand sol generator for prepartioning solution
+// rand sol generator for prepartioning solution - overwrites sol in place
 
-vector<double> rand_sol_prepart(int size) {
-    vector<double> sol;
-    for (int j = 0; (signed int) j < size; j++) {
+void rand_sol_prepart(vector<double> &sol) {
+    for (int j = 0; j < (signed int) sol.size(); j++) {
         // want to generate random index for prepartioning
-        sol.push_back(part_idx_gen(mersenne));
+        sol[j] = moves.bounded(sol.size());
     }
-    return sol;
 }
 
-vector<double> A_prime(vector<double> input, vector<double> sol) {
+// builds A' for sol into output (which must already be input-sized)
+void A_prime(const vector<double> &input, const vector<double> &sol, vector<double> &output) {
     int s = input.size();
-    vector<double> output(s, 0);
+    if (with_fixed_size(s, [&](auto n) {
+            A_prime_fixed<n>(span<const double, n>(input.data(), n),
+                             span<const double, n>(sol.data(), n),
+                             span<double, n>(output.data(), n));
+        })) {
+        return;
+    }
+    fill(output.begin(), output.end(), 0);
     for(int k = 0; (signed int) k < s; k++) {
-        output[sol[k]] += input[k]; 
+        output[sol[k]] += input[k];
+    }
+}
+
+// starting point for the prepartitioned heuristics: on warm start, put every
+// elt in its own class, so A' is just the input and KK on it reproduces the
+// KK residue exactly; otherwise uniformly random
+
+void init_sol_prepart(vector<double> &sol, workspace &ws) {
+    if (ws.warm_start) {
+        for (int j = 0; j < (signed int) sol.size(); j++) {
+            sol[j] = j;
+        }
+    }
+    else {
+        rand_sol_prepart(sol);
     }
-    return output;
+}
+
+// residue of a prepartition: A' then KK (k-way KK when ws.k > 2), all in
+// workspace buffers
+double prep_res_calc(const vector<double> &input, const vector<double> &sol,
+                     vector<double> &prime, workspace &ws) {
+    A_prime(input, sol, prime);
+    if (ws.k > 2) {
+        return kway_kar_karp(prime, ws.kk_tuples);
+    }
+    double residue;
+    if (with_fixed_size(prime.size(), [&](auto n) {
+            residue = kar_karp_fixed<n>(span<const double, n>(prime.data(), n));
+        })) {
+        return residue;
+    }
+    v_to_h(prime, ws.kk_heap);
+    return kar_karp(ws.kk_heap);
 }
 
 // random prepartitoning fn
-double prep_repeated_random(vector<double> A_input) {
+double prep_repeated_random(const vector<double> &A_input, workspace &ws) {
+    ws.ensure_prep();
     // first generate a random sol, its A', and residue - for loop will update this!
-    int s = A_input.size();
-    vector<double> sol = rand_sol_prepart(s);
-    vector<double> sol_prime = A_prime(A_input, sol);
-    double sol_res = kar_karp(v_to_h(sol_prime));
+    init_sol_prepart(ws.sol, ws);
+    double sol_res = prep_res_calc(A_input, ws.sol, ws.sol_prime, ws);
+    ws.note_best(0, sol_res);
 
     for (int i = 0; i < 25000; i++) {
         // generate random sol and its residue
-        vector<double> potential_sol = rand_sol_prepart(s);
-        vector<double> potential_prime = A_prime(A_input, potential_sol);
-        double potential_residue = kar_karp(v_to_h(potential_prime));
+        rand_sol_prepart(ws.neighbor);
+        double potential_residue = prep_res_calc(A_input, ws.neighbor, ws.neighbor_prime, ws);
 
         // Assign prepartitioning sequence w/ better residue to main solution
         if (potential_residue < sol_res) {
-            sol = potential_sol;
-            sol_prime = potential_prime;
+            ws.sol.swap(ws.neighbor);
+            ws.sol_prime.swap(ws.neighbor_prime);
             sol_res = potential_residue;
+            ws.note_best(i + 1, sol_res);
         }
     }
-    // return sol;
+    // return ws.sol;
     return sol_res;
 }
 
-// prepartioning hill climbing
-double prep_hill_climbing(vector<double> A_input) {
+// Batched neighbor evaluation for the prepartitioned hill climbing and
+// annealing. Both only ever look at neighbors of their current S, whose A'
+// differs from S's in at most 4 classes, so rather than A_prime -> v_to_h ->
+// kar_karp per neighbor, we keep S's nonzero A' values sorted and, for a block
+// of prep_batch_size moves at once:
+//   1. build each neighbor's sorted A' in one merge pass over S's, dropping
+//      the changed classes' old sums and merging in their new ones
+//   2. run KK on all of them together on the sorted arrays, one step of each
+//      in turn, where a step takes the front two and slides the difference
+//      down to its place - a short predictable loop instead of heap sifts.
+//      The slide is O(m) per step though, so O(m^2) per KK: measured per
+//      block of 8, it's 2x faster than heaps at m = 65 (21 vs 41 us), about
+//      even around m = 290 (215 vs 213 us), and 3x slower by m = 1262 (4.9
+//      vs 1.7 ms). So from prep_slide_max_len sums on, each row gets heap KK
+// The heuristic then walks the block in order with its usual accept rule,
+// one iteration per move, so it behaves exactly like drawing one neighbor at
+// a time: the first accepted move is applied and the rest of the block,
+// which were neighbors of the old S, are dropped. k > 2 keeps the original
+// one-at-a-time loops with k-way KK.
+
+// KK on B descending-sorted arrays (row b at rows + b * stride, len[b] long)
+template <int B>
+void kar_karp_sorted_batch(double *rows, const int *len, int stride, double *out) {
+    int head[B];
+    int max_len = 0;
+    for (int b = 0; b < B; b++) {
+        head[b] = 0;
+        max_len = max(max_len, len[b]);
+    }
+    for (int step = 0; step < max_len - 1; step++) {
+        for (int b = 0; b < B; b++) {
+            if (len[b] - head[b] <= 1) {
+                continue;
+            }
+            double *row = rows + b * stride;
+            double diff = row[head[b]] - row[head[b] + 1];
+            head[b] += 1;
+            // the pair's slots are free now; shift bigger values up into them
+            int p = head[b];
+            while (p + 1 < len[b] && row[p + 1] > diff) {
+                row[p] = row[p + 1];
+                p++;
+            }
+            row[p] = diff;
+        }
+    }
+    for (int b = 0; b < B; b++) {
+        out[b] = len[b] > 0 ? rows[b * stride + head[b]] : 0;
+    }
+}
+
+// KK on one descending-sorted array, which is already a max-heap, so it can
+// go straight to heap pops and pushes in place - O(m log m) where the slide
+// above is O(m^2) once the differences get small
+double kar_karp_sorted_heap(double *row, int len) {
+    while (len > 1) {
+        pop_heap(row, row + len);
+        pop_heap(row, row + len - 1);
+        len--;
+        row[len - 1] = row[len] - row[len - 1];
+        push_heap(row, row + len);
+    }
+    return len > 0 ? row[0] : 0;
+}
+
+// sorts a short list (<= 4 sums) descending, dropping zeros; returns its new
+// length
+int sort_nonzero_desc(double *v, int m) {
+    int len = 0;
+    for (int j = 0; j < m; j++) {
+        double x = v[j];
+        if (x == 0) {
+            continue;
+        }
+        // insertion sort, it's at most 4 long
+        int p = len++;
+        while (p > 0 && v[p - 1] < x) {
+            v[p] = v[p - 1];
+            p--;
+        }
+        v[p] = x;
+    }
+    return len;
+}
+
+// S's sorted nonzero A' with one move applied, written to out; returns length
+int merge_neighbor_prime(const vector<double> &sorted_prime, int m, const prep_move &mv, double *out) {
+    double old_vals[4];
+    double new_vals[4];
+    for (int j = 0; j < mv.changes; j++) {
+        old_vals[j] = mv.old_sum[j];
+        new_vals[j] = mv.new_sum[j];
+    }
+    int n_old = sort_nonzero_desc(old_vals, mv.changes);
+    int n_new = sort_nonzero_desc(new_vals, mv.changes);
+    int o = 0;
+    int nv = 0;
+    int len = 0;
+    for (int p = 0; p < m; p++) {
+        // old sums are all in sorted_prime, and both lists run descending
+        if (o < n_old && sorted_prime[p] == old_vals[o]) {
+            o++;
+            continue;
+        }
+        while (nv < n_new && new_vals[nv] >= sorted_prime[p]) {
+            out[len++] = new_vals[nv++];
+        }
+        out[len++] = sorted_prime[p];
+    }
+    while (nv < n_new) {
+        out[len++] = new_vals[nv++];
+    }
+    return len;
+}
+
+// rebuilds S's sorted nonzero A' from S_prime, returns its length
+int build_sorted_prime(const vector<double> &S_prime, vector<double> &sorted_prime) {
+    int len = 0;
+    for (int j = 0; j < (signed int) S_prime.size(); j++) {
+        if (S_prime[j] != 0) {
+            sorted_prime[len++] = S_prime[j];
+        }
+    }
+    sort(sorted_prime.begin(), sorted_prime.begin() + len, greater<double>());
+    return len;
+}
+
+// proposes count (<= prep_batch_size) neighbors of S (its A' in
+// ws.sol_prime, its sorted nonzero A' in ws.sorted_prime, m long) and scores
+// them into ws.batch_moves and ws.batch_res - k = 2 only
+void prep_eval_batch(const vector<double> &A_input, const vector<double> &S, workspace &ws, int m, int count) {
+    assert(ws.k == 2 && count >= 1 && count <= prep_batch_size);
+    int s = A_input.size();
+    const vector<double> &S_prime = ws.sol_prime;
+    // unused rows are empty, so the batched KK skips them
+    for (int b = count; b < prep_batch_size; b++) {
+        ws.batch_len[b] = 0;
+    }
+    for (int b = 0; b < count; b++) {
+        prep_move &mv = ws.batch_moves[b];
+        // with prob 1/2 a second, distinct idx; each changed idx always moves
+        // to a different class
+        moves.pick_idxs(s, mv.idx_1, mv.idx_2);
+        mv.class_1 = moves.other_than(S[mv.idx_1], s);
+        mv.changes = 0;
+        mv.add(S[mv.idx_1], -A_input[mv.idx_1], S_prime);
+        mv.add(mv.class_1, A_input[mv.idx_1], S_prime);
+        if (mv.idx_2 >= 0) {
+            mv.class_2 = moves.other_than(S[mv.idx_2], s);
+            mv.add(S[mv.idx_2], -A_input[mv.idx_2], S_prime);
+            mv.add(mv.class_2, A_input[mv.idx_2], S_prime);
+        }
+        ws.batch_len[b] = merge_neighbor_prime(ws.sorted_prime, m, mv, &ws.batch_rows[b * s]);
+    }
+    if (m < prep_slide_max_len) {
+        kar_karp_sorted_batch<prep_batch_size>(ws.batch_rows.data(), ws.batch_len, s, ws.batch_res);
+        return;
+    }
+    for (int b = 0; b < count; b++) {
+        ws.batch_res[b] = kar_karp_sorted_heap(&ws.batch_rows[b * s], ws.batch_len[b]);
+    }
+}
+
+// moves S to batch neighbor b: updates S, its A', and its sorted A'
+void prep_apply_move(vector<double> &S, workspace &ws, int b, int &m) {
+    const prep_move &mv = ws.batch_moves[b];
+    S[mv.idx_1] = mv.class_1;
+    if (mv.idx_2 >= 0) {
+        S[mv.idx_2] = mv.class_2;
+    }
+    for (int j = 0; j < mv.changes; j++) {
+        ws.sol_prime[mv.cls[j]] = mv.new_sum[j];
+    }
+    // KK consumed the batch rows, so redo this one's merge (into its now free
+    // row) to get the new sorted A'
+    int s = S.size();
+    double *row = &ws.batch_rows[b * s];
+    m = merge_neighbor_prime(ws.sorted_prime, m, mv, row);
+    copy(row, row + m, ws.sorted_prime.begin());
+}
+
+// size of the next block: after an accept, as many moves as that block got
+// through (so while nearly everything is accepted, as early in annealing, few
+// scored moves get dropped); after a block with none accepted, double it
+int prep_next_count(int count, int used, bool accepted) {
+    if (accepted) {
+        return used;
+    }
+    return min(2 * count, prep_batch_size);
+}
+
+// prepartioning hill climbing, one neighbor at a time - used for k > 2, where
+// neighbors are scored with k-way KK
+double prep_hill_climbing_single(const vector<double> &A_input, workspace &ws) {
     // first generate a random sol, its A', and residue - for loop will update this!
     int s = A_input.size();
-    vector<double> opt_sol = rand_sol_prepart(s);
-    vector<double> sol_prime = A_prime(A_input, opt_sol);
-    double sol_res = kar_karp(v_to_h(sol_prime));
+    vector<double> &opt_sol = ws.sol;
+    vector<double> &neighbor = ws.neighbor;
+    init_sol_prepart(opt_sol, ws);
+    double sol_res = prep_res_calc(A_input, opt_sol, ws.sol_prime, ws);
+    ws.note_best(0, sol_res);
 
     // initialize neighbor stuff, will be found in for loop
-    vector<double> neighbor = opt_sol;
-    vector<double> neighbor_prime = sol_prime;
+    neighbor = opt_sol;
     double neighbor_res;
 
     for (int i = 0; i < 25000; i++) {
         // calculate neighbor to current optimal, off at 1 idx
-        int idx_1 = part_idx_gen(mersenne);
-        neighbor[idx_1] = part_idx_gen(mersenne);
-
-        // with prob 1/2, we also change a second, distinct idx
-        int prob = value_gen(mersenne);
-        if (prob == 0) {
-            while (true) {
-                int idx_2 = part_idx_gen(mersenne);
-                if (idx_2 != idx_1) {
-                    neighbor[idx_2] = part_idx_gen(mersenne);
-                    break;
-                }
-            }
+        // with prob 1/2, we also change a second, distinct idx - and each
+        // changed idx always moves to a different class, never a no-op
+        int idx_1, idx_2;
+        moves.pick_idxs(s, idx_1, idx_2);
+        neighbor[idx_1] = moves.other_than(neighbor[idx_1], s);
+        if (idx_2 >= 0) {
+            neighbor[idx_2] = moves.other_than(neighbor[idx_2], s);
         }
-        neighbor_prime = A_prime(A_input, neighbor);
-        neighbor_res = kar_karp(v_to_h(neighbor_prime));
+        neighbor_res = prep_res_calc(A_input, neighbor, ws.neighbor_prime, ws);
 
         // If neighbor sol is better, make it opt
         if (neighbor_res < sol_res) {
-            opt_sol = neighbor;
-            sol_prime = neighbor_prime;
+            opt_sol[idx_1] = neighbor[idx_1];
+            if (idx_2 >= 0) {
+                opt_sol[idx_2] = neighbor[idx_2];
+            }
+            ws.sol_prime.swap(ws.neighbor_prime);
             sol_res = neighbor_res;
+            ws.note_best(i + 1, sol_res);
         }
         // update so on next iter we look at neighbors of curr opt - neighbor prime and
-        // res are updated based on neighbor each iter, so only need to reset neighbor
-        neighbor = opt_sol;
+        // res are rebuilt from neighbor each iter, so only need to undo the changed idxs
+        else {
+            neighbor[idx_1] = opt_sol[idx_1];
+            if (idx_2 >= 0) {
+                neighbor[idx_2] = opt_sol[idx_2];
+            }
+        }
     }
     // return opt_sol;
     return sol_res;
 }
 
-double prep_simulated_annealing(vector<double> A_input) {
+// prepartioning simulated annealing, one neighbor at a time - used for k > 2
+double prep_simulated_annealing_single(const vector<double> &A_input, workspace &ws) {
     // first generate a random sol, its A', and residue - for loop will update this!
     int s = A_input.size();
-    vector<double> S_double_sol = rand_sol_prepart(s);
-    vector<double> S_double_prime = A_prime(A_input, S_double_sol);
-    double S_double_res = kar_karp(v_to_h(S_double_prime));
+    vector<double> &S_double_sol = ws.best_sol;
+    init_sol_prepart(S_double_sol, ws);
+    double S_double_res = prep_res_calc(A_input, S_double_sol, ws.sol_prime, ws);
+    ws.note_best(0, S_double_res);
 
     // initialize S and neighbor vals to same, will be modified
-    vector<double> S_sol = S_double_sol;
-    vector<double> S_prime = S_double_prime;
+    vector<double> &S_sol = ws.sol;
+    S_sol = S_double_sol;
     double S_res = S_double_res;
 
-    vector<double> neighbor = S_double_sol;
-    vector<double> neighbor_prime = S_double_prime;
+    vector<double> &neighbor = ws.neighbor;
+    neighbor = S_double_sol;
     double neighbor_res = S_double_res;
 
     for (int i = 0; i < 25000; i++) {
         // calculate neighbor to current optimal, off at 1 idx
-        int idx_1 = part_idx_gen(mersenne);
-        neighbor[idx_1] = part_idx_gen(mersenne);
-
-        // with prob 1/2, we also change a second, distinct idx
-        int prob = value_gen(mersenne);
-        if (prob == 0) {
-            while (true) {
-                int idx_2 = part_idx_gen(mersenne);
-                if (idx_2 != idx_1) {
-                    neighbor[idx_2] = part_idx_gen(mersenne);
-                    break;
-                }
-            }
+        // with prob 1/2, we also change a second, distinct idx - and each
+        // changed idx always moves to a different class, never a no-op
+        int idx_1, idx_2;
+        moves.pick_idxs(s, idx_1, idx_2);
+        neighbor[idx_1] = moves.other_than(neighbor[idx_1], s);
+        if (idx_2 >= 0) {
+            neighbor[idx_2] = moves.other_than(neighbor[idx_2], s);
         }
 
-        neighbor_prime = A_prime(A_input, neighbor);
-        neighbor_res = kar_karp(v_to_h(neighbor_prime));
+        neighbor_res = prep_res_calc(A_input, neighbor, ws.neighbor_prime, ws);
 
-        float random_annealing = annealing_gen(mersenne);
+        double random_annealing = moves.uniform();
 
         // if neighbor is better or annealing prob, we update S
         if (neighbor_res < S_res || random_annealing <= exp(-((neighbor_res - S_res)/(pow(10,10) * pow(0.8,(i/300)))))) {
-            S_sol = neighbor;
-            S_prime = neighbor_prime;
+            S_sol[idx_1] = neighbor[idx_1];
+            if (idx_2 >= 0) {
+                S_sol[idx_2] = neighbor[idx_2];
+            }
             S_res = neighbor_res;
         }
+        // otherwise undo the changed idxs, so on next iter we look for neighbors of current S
+        else {
+            neighbor[idx_1] = S_sol[idx_1];
+            if (idx_2 >= 0) {
+                neighbor[idx_2] = S_sol[idx_2];
+            }
+        }
 
         // regardless of above, we check if S'' should be updated
         if (S_res < S_double_res) {
             S_double_sol = S_sol;
-            S_double_prime = S_prime;
             S_double_res = S_res;
+            ws.note_best(i + 1, S_double_res);
         }
-        // always reset neighbor to S, so on next iter we look for neighbors of current S
-        neighbor = S_sol;
     }
     // return best sol we've ever seen
     // return S_double_sol;
     return S_double_res;
 }
 
+// prepartioning hill climbing
+double prep_hill_climbing(const vector<double> &A_input, workspace &ws) {
+    ws.ensure_prep();
+    if (ws.k > 2) {
+        return prep_hill_climbing_single(A_input, ws);
+    }
+    ws.ensure_batch();
+    // first generate a random sol, its A', and residue - for loop will update this!
+    vector<double> &opt_sol = ws.sol;
+    init_sol_prepart(opt_sol, ws);
+    double sol_res = prep_res_calc(A_input, opt_sol, ws.sol_prime, ws);
+    int m = build_sorted_prime(ws.sol_prime, ws.sorted_prime);
+    ws.note_best(0, sol_res);
+
+    // each block scores count neighbors of the current opt, then they're
+    // taken in order, one iteration each, as if drawn one at a time: the
+    // first better one becomes opt and the rest (neighbors of the old opt)
+    // are dropped for a fresh block
+    int i = 0;
+    int count = prep_batch_size;
+    while (i < 25000) {
+        prep_eval_batch(A_input, opt_sol, ws, m, count);
+        int used = 0;
+        bool accepted = false;
+        while (used < count && i < 25000 && !accepted) {
+            int b = used++;
+            i++;
+            // If neighbor sol is better, make it opt
+            if (ws.batch_res[b] < sol_res) {
+                prep_apply_move(opt_sol, ws, b, m);
+                sol_res = ws.batch_res[b];
+                ws.note_best(i, sol_res);
+                accepted = true;
+            }
+        }
+        count = prep_next_count(count, used, accepted);
+    }
+    // return opt_sol;
+    return sol_res;
+}
+
+double prep_simulated_annealing(const vector<double> &A_input, workspace &ws) {
+    ws.ensure_prep();
+    if (ws.k > 2) {
+        return prep_simulated_annealing_single(A_input, ws);
+    }
+    ws.ensure_batch();
+    // first generate a random sol, its A', and residue - for loop will update this!
+    vector<double> &S_sol = ws.sol;
+    init_sol_prepart(S_sol, ws);
+    double S_res = prep_res_calc(A_input, S_sol, ws.sol_prime, ws);
+    int m = build_sorted_prime(ws.sol_prime, ws.sorted_prime);
+
+    // S'' starts as S, will only be copied over when S beats it
+    vector<double> &S_double_sol = ws.best_sol;
+    S_double_sol = S_sol;
+    double S_double_res = S_res;
+    ws.note_best(0, S_double_res);
+
+    // each block scores count neighbors of the current S, then the annealing
+    // rule goes through them in order, one iteration each, as if drawn one at
+    // a time: the first accepted one becomes S and the rest (neighbors of the
+    // old S) are dropped for a fresh block
+    int i = 0;
+    int count = prep_batch_size;
+    while (i < 25000) {
+        prep_eval_batch(A_input, S_sol, ws, m, count);
+        int used = 0;
+        bool accepted = false;
+        while (used < count && i < 25000 && !accepted) {
+            int b = used++;
+            double neighbor_res = ws.batch_res[b];
+            double random_annealing = moves.uniform();
+
+            // if neighbor is better or annealing prob, we update S
+            if (neighbor_res < S_res || random_annealing <= exp(-((neighbor_res - S_res)/(pow(10,10) * pow(0.8,(i/300)))))) {
+                prep_apply_move(S_sol, ws, b, m);
+                S_res = neighbor_res;
+                accepted = true;
+            }
+            i++;
+
+            // regardless of above, we check if S'' should be updated
+            if (S_res < S_double_res) {
+                S_double_sol = S_sol;
+                S_double_res = S_res;
+                ws.note_best(i, S_double_res);
+            }
+        }
+        count = prep_next_count(count, used, accepted);
+    }
+    // return best sol we've ever seen
+    // return S_double_sol;
+    return S_double_res;
+}
+
+// drivers built on the algorithms above
+#include "bench.cc"
+#include "gen.cc"
+
 int main(int argc, char** argv) {
-    // experiments for report - 50 trials for all algorithms
-    // uniform_int_distribution<double> big_gen(0,0xE8D4A51000);
-    // printf("%f\n", big_gen(mersenne));
-    // return 0;
-
-
-
-
-    // double kk_total;
-    // double std_rand;
-    // double std_hill;
-    // double std_anneal;
-    // double part_rand;
-    // double part_hill;
-    // double part_anneal;
-
-
-    // for (int t = 0; t < 50; t++) {
-    //     printf("%i\n", t);
-    //     vector<double> in_vector;
-    //     heap in_heap;
-    //     for (int i = 0; i < 100; i++) {
-    //         double val = distribution(generator);
-    //         in_vector.push_back(val);
-    //         in_heap.insert(val);
-    //     }
-    //     kk_total += kar_karp(in_heap);
-    //     std_rand += std_repeated_random(in_vector);
-    //     std_hill += std_hill_climbing(in_vector);
-    //     std_anneal += std_simulated_annealing(in_vector);
-    //     part_rand += prep_repeated_random(in_vector);
-    //     part_hill += prep_hill_climbing(in_vector);
-    //     part_anneal += prep_simulated_annealing(in_vector);
-    // }
-
-    // printf("kk: %f\n", kk_total/50);
-    // printf("std_rand: %f\n", std_rand/50);
-    // printf("std_hill: %f\n", std_hill/50);
-    // printf("std_anneal: %f\n", std_anneal/50);
-    // printf("part_rand: %f\n", part_rand/50);
-    // printf("part_hill: %f\n", part_hill/50);
-    // printf("part_anneal: %f\n", part_anneal/50);
-
-    // return 0;
-
-    assert(argc == 4);
-    // flag 0 for grading as described in P3 description
-    // int _flag = atoi(argv[1]);
-    // algorithm codes in P3 description
+    // experiments for report: ./partition bench [trials] [seed], see bench.cc
+    if (argc >= 2 && string(argv[1]) == "bench") {
+        return run_bench(argc, argv);
+    }
+    // instance generation: ./partition gen <dist> <n> <count> <seed> <prefix>, see gen.cc
+    if (argc >= 2 && string(argv[1]) == "gen") {
+        return run_gen(argc, argv);
+    }
+
+    // switches in front of the usual args: ./partition [--warm] [--stream MB] flag algorithm inputfile [k]
+    //   --warm starts the heuristics from the KK partition instead of a random one
+    //   --stream MB runs out-of-core KK (algorithm 0, k = 2) in at most ~MB MB
+    bool warm_start = false;
+    int stream_mb = 0;
+    while (argc >= 2 && argv[1][0] == '-' && argv[1][1] == '-') {
+        if (string(argv[1]) == "--warm") {
+            warm_start = true;
+        }
+        else if (string(argv[1]) == "--stream" && argc >= 3) {
+            stream_mb = atoi(argv[2]);
+            assert(stream_mb > 0);
+            argv++;
+            argc--;
+        }
+        else {
+            assert(false);
+        }
+        argv++;
+        argc--;
+    }
+
+    assert(argc == 4 || argc == 5);
+    // flag 0 for grading as described in P3 description, no other values mean anything
+    int flag = atoi(argv[1]);
+    assert(flag == 0);
+    // algorithm codes in P3 description, plus 4 for 16-lane lockstep hill climbing
+    // and 5 for sorted-index steepest descent
     int algorithm = atoi(argv[2]);
+    // optional 4th arg: number of subsets k for k-way partitioning (default 2);
+    // k > 2 supports KK (0) and the prepartitioned heuristics (11-13)
+    int k = 2;
+    if (argc == 5) {
+        k = atoi(argv[4]);
+        assert(k >= 2);
+    }
+
+    // streaming KK never loads the whole input, so handle it before reading
+    if (stream_mb > 0) {
+        assert(algorithm == 0 && k == 2 && !warm_start);
+        double answer = streaming_kar_karp(argv[3], (long long) stream_mb << 20);
+        printf("%lld\n", (long long) answer);
+        return 0;
+    }
 
     // Read the 100 numbers from the input file
     // Initialize the input file outputs, prepare for reading
     heap input_heap;
     vector<double> input_vector;
 
-    ifstream input_file;
-    input_file.open(argv[3]);
-    string line;
-    while(getline(input_file, line)) {
-        input_heap.insert(stod(line));
-        input_vector.push_back(stod(line));
+    // .bin files from the generator (raw little-endian uint64s) are read as is
+    if (is_bin_path(argv[3])) {
+        FILE *in = fopen(argv[3], "rb");
+        assert(in != NULL);
+        bin_reader reader(in, 1 << 20);
+        double val;
+        while (reader.next(val)) {
+            input_heap.insert(val);
+            input_vector.push_back(val);
+        }
+        fclose(in);
+    }
+    else {
+        ifstream input_file;
+        input_file.open(argv[3]);
+        string line;
+        while(getline(input_file, line)) {
+            input_heap.insert(stod(line));
+            input_vector.push_back(stod(line));
+        }
     }
 
     double answer;
+    // KK's partition is 2-way only, and KK itself has nothing to warm start
+    assert(!warm_start || (k == 2 && algorithm != 0));
+    // standard representation is +/-1 signs, so it only makes sense for k = 2
+    assert(k == 2 || algorithm == 0 || algorithm >= 11);
 
-    switch (algorithm) {
-        case 0:
+    // KK needs nothing but its heap
+    if (algorithm == 0) {
+        if (k > 2) {
+            tuple_heap th;
+            th.reserve(input_vector.size(), k);
+            answer = kway_kar_karp(input_vector, th);
+        }
+        else {
             answer = kar_karp(input_heap);
-            printf("%lld\n", (long long) answer);
-            break;
+        }
+        printf("%lld\n", (long long) answer);
+        return 0;
+    }
+
+    // the heuristics' buffers, sized once up front
+    workspace ws(input_vector.size(), k);
+    ws.warm_start = warm_start;
+
+    switch (algorithm) {
         case 1:
-            answer = std_repeated_random(input_vector);
+            answer = std_repeated_random(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break;
         case 2:
-            answer = std_hill_climbing(input_vector);
+            answer = std_hill_climbing(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break;
         case 3:
-            answer = std_simulated_annealing(input_vector);
+            answer = std_simulated_annealing(input_vector, ws);
+            printf("%lld\n", (long long) answer);
+            break;
+        case 4:
+            answer = std_hill_climbing_lanes<lane_count>(input_vector, ws);
+            printf("%lld\n", (long long) answer);
+            break;
+        case 5:
+            answer = std_steepest_descent(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break;
         case 11:
-            answer = prep_repeated_random(input_vector);
+            answer = prep_repeated_random(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break; 
         case 12:
-            answer = prep_hill_climbing(input_vector);
+            answer = prep_hill_climbing(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break;  
         case 13:
-            answer = prep_simulated_annealing(input_vector);
+            answer = prep_simulated_annealing(input_vector, ws);
             printf("%lld\n", (long long) answer);
             break; 
         default:
             assert(false);
             break;
     }
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <cstdint>
+using namespace std;
+
+// Small, fast PRNG plus the bounded-int helpers the heuristics use to build
+// neighbors. xoshiro256++ gives 64 good bits per call in a handful of ops, and
+// each call is cut into two 32-bit fields (plus a separate pool of single-bit
+// coin flips), so one output usually covers a whole move. Bounded ints use
+// Lemire's multiply-shift, which only needs a division in the rare case the
+// low half of the product falls below the range.
+
+// one xoshiro256++ step on state words s0..s3, returning the output - shared
+// by the generator below and the lockstep lanes
+inline uint64_t xoshiro_step(uint64_t &s0, uint64_t &s1, uint64_t &s2, uint64_t &s3) {
+    uint64_t sum = s0 + s3;
+    uint64_t result = ((sum << 23) | (sum >> 41)) + s0;
+    uint64_t t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 45) | (s3 >> 19);
+    return result;
+}
+
+struct xoshiro256pp {
+    uint64_t s[4];
+
+    // expand one seed into the 4 state words with splitmix64, as recommended
+    void seed(uint64_t x) {
+        for (int i = 0; i < 4; i++) {
+            x += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        return xoshiro_step(s[0], s[1], s[2], s[3]);
+    }
+
+    // uniform in [0, range) for 64-bit ranges (instance values up to 10^12),
+    // Lemire's method on the full 128-bit product
+    uint64_t below(uint64_t range) {
+        __uint128_t m = (__uint128_t) next() * range;
+        uint64_t l = (uint64_t) m;
+        if (l < range) {
+            uint64_t t = -range % range;
+            while (l < t) {
+                m = (__uint128_t) next() * range;
+                l = (uint64_t) m;
+            }
+        }
+        return m >> 64;
+    }
+};
+
+// L xoshiro256++ streams stepped together, state kept as one array per word
+// (structure of arrays) so next() is a plain loop over lanes of the same step
+template <int L>
+struct xoshiro256pp_lanes {
+    uint64_t s0[L], s1[L], s2[L], s3[L];
+
+    // each lane gets its own splitmix expansion of one draw from from
+    void seed(xoshiro256pp &from) {
+        for (int c = 0; c < L; c++) {
+            xoshiro256pp lane;
+            lane.seed(from.next());
+            s0[c] = lane.s[0];
+            s1[c] = lane.s[1];
+            s2[c] = lane.s[2];
+            s3[c] = lane.s[3];
+        }
+    }
+
+    // one output per lane into out
+    void next(uint64_t *out) {
+        for (int c = 0; c < L; c++) {
+            out[c] = xoshiro_step(s0[c], s1[c], s2[c], s3[c]);
+        }
+    }
+};
+
+struct move_gen {
+    xoshiro256pp rng;
+    // unused 32-bit half of the last output, and unused coin flips
+    uint64_t half_bits = 0;
+    bool half_left = false;
+    uint64_t coin_bits = 0;
+    int coins_left = 0;
+
+    move_gen(uint64_t seed) {
+        rng.seed(seed);
+    }
+
+    uint32_t next32() {
+        if (half_left) {
+            half_left = false;
+            return half_bits;
+        }
+        uint64_t r = rng.next();
+        half_bits = r >> 32;
+        half_left = true;
+        return (uint32_t) r;
+    }
+
+    // fair coin, 64 flips per output
+    bool coin() {
+        if (coins_left == 0) {
+            coin_bits = rng.next();
+            coins_left = 64;
+        }
+        bool out = coin_bits & 1;
+        coin_bits >>= 1;
+        coins_left -= 1;
+        return out;
+    }
+
+    // uniform int in [0, range), Lemire's nearly divisionless method
+    uint32_t bounded(uint32_t range) {
+        uint64_t m = (uint64_t) next32() * range;
+        uint32_t l = (uint32_t) m;
+        if (l < range) {
+            uint32_t t = -range % range;
+            while (l < t) {
+                m = (uint64_t) next32() * range;
+                l = (uint32_t) m;
+            }
+        }
+        return m >> 32;
+    }
+
+    // uniform in [0, 1) from the top 53 bits
+    double uniform() {
+        return (rng.next() >> 11) * 0x1.0p-53;
+    }
+
+    // uniform int in [0, range) other than skip - draws from the range - 1
+    // other values and shifts past skip, so no rejection loop (range >= 2)
+    int other_than(int skip, int range) {
+        return (skip + 1 + (int) bounded(range - 1)) % range;
+    }
+
+    // the idxs a neighbor move changes: idx_1 always, and with prob 1/2 a
+    // distinct idx_2 (else idx_2 = -1)
+    void pick_idxs(int size, int &idx_1, int &idx_2) {
+        idx_1 = bounded(size);
+        idx_2 = (coin() && size > 1) ? other_than(idx_1, size) : -1;
+    }
+};